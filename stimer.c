@@ -1,22 +1,48 @@
 #include "stimer.h"
 #include <string.h>
 
-static void stimer_reset(void);
 static void stimer_scheduler(uint16_t id);
+static void stimer_wait_clear(void);
+static void stimer_wait_link(uint16_t id);
+static uint8_t stimer_wait_unlink(uint16_t id);
+static uint8_t stimer_wait_contains(uint16_t id);
+static uint16_t stimer_wait_first(void);
+static uint16_t stimer_wait_due(stimer_time_t now);
+static uint16_t stimer_wait_find_callback(stimer_pfunc_t task_callback);
+#if !!(STIMER_ONESHOT_INDEX_ENABLE)
+static void stimer_index_clear(void);
+static void stimer_index_add(uint16_t id);
+static void stimer_index_del(uint16_t id);
+static uint16_t stimer_index_find(stimer_pfunc_t task_callback);
+#endif
+#if ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_WHEEL)
+static void stimer_wheel_rebuild(stimer_time_t time);
+#endif
 stimer_t hstimer;
 
 void stimer_init(stimer_task_t *pTasks, uint16_t Size)
 {
+    uint16_t i;
     STIMER_ASSERT(pTasks != NULL);
-    STIMER_ASSERT(Size != 0);
+    STIMER_ASSERT(Size != 0 && Size != STIMER_ID_NONE);
     memset(pTasks, 0, sizeof(stimer_task_t) * Size);
+    /* 所有任务槽位串联成空闲链表 */
+    for (i = 0; i < Size; i++)
+    {
+        pTasks[i].next_id = i + 1 < Size ? i + 1 : STIMER_ID_NONE;
+    }
+    hstimer.free_id = 0;
+    hstimer.free_cnt = Size;
     hstimer.ptask = NULL;
     hstimer.ptasks = pTasks;
     hstimer.size = Size;
     hstimer.timetick = 0;
     hstimer.wait_cnt = 0;
     hstimer.wait_id = 0;
+    #if !(STIMER_TIME_64BIT_ENABLE)
     hstimer.reset_cnt = 0;
+    #endif
+    stimer_wait_clear();
     #if !!(STIMER_TASK_HOOK_ENABLE)
     hstimer.task_start_hook = NULL;
     hstimer.task_end_hook = NULL;
@@ -26,6 +52,10 @@ void stimer_init(stimer_task_t *pTasks, uint16_t Size)
     #if !!(STIMER_ASSERT_ENABLE)
     hstimer.user_assert_callback = NULL;
     #endif
+    #if !!(STIMER_ONESHOT_INDEX_ENABLE)
+    hstimer.index = NULL;
+    hstimer.index_mask = 0;
+    #endif
 }
 
 /**
@@ -35,28 +65,32 @@ void stimer_init(stimer_task_t *pTasks, uint16_t Size)
  * @param priority task priority
  * @param reserved task will be saved unless manually deleted
  * @retval uint16_t task ID [< hstimer.size : ok], [>= hstimer.size : fail]
- * @note Use the function after stimer_init()
+ * @note Use the function after stimer_init(), the last released slot is reused first
  */
 uint16_t stimer_create_task(stimer_pfunc_t task_callback, stimer_time_t interval, uint8_t priority, uint8_t reserved)
 {
     STIMER_ASSERT(task_callback != NULL);
     STIMER_ASSERT(priority <= STIMER_MAX_PRIORITY);
 
-    uint32_t i;
+    uint16_t i;
     STIMER_DISABLE_INTERRUPTS();
-    /* 查找空闲的任务槽位 */
-    for (i = 0; i < hstimer.size; i++)
+    /* 从空闲链表取出任务槽位 */
+    i = hstimer.free_id;
+    if (i != STIMER_ID_NONE)
     {
-        if (hstimer.ptasks[i].task_callback == NULL && hstimer.ptasks[i].reserved == 0)
-        {
-            /* 写入任务参数 */
-            hstimer.ptasks[i].task_callback = task_callback;
-            hstimer.ptasks[i].interval = interval;
-            hstimer.ptasks[i].priority = priority;
-            hstimer.ptasks[i].reserved = reserved ? 1 : 0;
-            hstimer.ptasks[i].repetitions = 0;
-            break;
-        }
+        STIMER_ASSERT(hstimer.ptasks[i].task_callback == NULL && hstimer.ptasks[i].reserved == 0);
+        hstimer.free_id = hstimer.ptasks[i].next_id;
+        hstimer.free_cnt--;
+        /* 写入任务参数 */
+        hstimer.ptasks[i].task_callback = task_callback;
+        hstimer.ptasks[i].interval = interval;
+        hstimer.ptasks[i].priority = priority;
+        hstimer.ptasks[i].reserved = reserved ? 1 : 0;
+        hstimer.ptasks[i].repetitions = 0;
+    }
+    else
+    {
+        i = hstimer.size;
     }
     STIMER_ENABLE_INTERRUPTS();
     return i;
@@ -73,32 +107,32 @@ uint16_t stimer_create_task(stimer_pfunc_t task_callback, stimer_time_t interval
  */
 uint16_t stimer_task_oneshot(stimer_pfunc_t task_callback, stimer_time_t interval, uint8_t priority, void *arg)
 {
-    uint16_t id, i, flag = 0;
+    uint16_t id, flag = 0;
     STIMER_DISABLE_INTERRUPTS();
-    id = hstimer.wait_id;
     /* 寻找相同回调函数的任务 */
-    for (i = 0; i < hstimer.wait_cnt; i++)
+    #if !!(STIMER_ONESHOT_INDEX_ENABLE)
+    id = hstimer.index != NULL ? stimer_index_find(task_callback)
+                               : stimer_wait_find_callback(task_callback);
+    #else
+    id = stimer_wait_find_callback(task_callback);
+    #endif
+    if (id < hstimer.size)
     {
-        if (hstimer.ptasks[id].task_callback == task_callback && hstimer.ptasks[id].reserved == 0)
+        /* 更新任务配置 */
+        hstimer.ptasks[id].interval = interval;
+        hstimer.ptasks[id].priority = priority;
+        hstimer.ptasks[id].repetitions = 1;
+        #if !!(STIMER_TASK_ARG_ENABLE)
         {
-            /* 更新任务配置 */
-            hstimer.ptasks[id].interval = interval;
-            hstimer.ptasks[id].priority = priority;
-            hstimer.ptasks[id].repetitions = 1;
-            #if !!(STIMER_TASK_ARG_ENABLE)
-            {
-                hstimer.ptasks[id].arg = arg;
-            }
-            #endif
-             /* 如果当前任务在运行，运行完成后再进行调度 */
-            if (hstimer.ptask != &hstimer.ptasks[id])
-            {
-                stimer_scheduler(id);
-            }
-			flag = 1;
-            break;
+            hstimer.ptasks[id].arg = arg;
         }
-        id = hstimer.ptasks[id].next_id;
+        #endif
+        /* 如果当前任务在运行，运行完成后再进行调度 */
+        if (hstimer.ptask != &hstimer.ptasks[id])
+        {
+            stimer_scheduler(id);
+        }
+        flag = 1;
     }
     STIMER_ENABLE_INTERRUPTS();
     if (flag == 1)
@@ -158,58 +192,136 @@ void stimer_task_start(uint16_t id, uint16_t repetitions, void *arg)
 static void stimer_scheduler(uint16_t id)
 {
     STIMER_ASSERT(id < hstimer.size);
-    uint32_t i, min, lmin;
-    min = hstimer.wait_id;
-    lmin = hstimer.wait_id;
+    #if !(STIMER_TIME_64BIT_ENABLE)
+    /* 时刻计数允许回绕,到期时间按序列号比较,间隔不能超过计数范围的一半 */
+    STIMER_ASSERT(hstimer.ptasks[id].interval <= STIMER_MAX_INTERVAL);
+    #endif
     if (hstimer.ptasks[id].repetitions == 0) return;
-    /* 计算到期时间 */
-    if (STIMER_MAX_TIMETICK - hstimer.timetick < hstimer.ptasks[id].interval)
+    /* 将任务安排到计划表,等待列表中存在该任务则重新安排 */
+    uint8_t waiting = stimer_wait_unlink(id);
+    hstimer.ptasks[id].expire = hstimer.ptasks[id].interval + hstimer.timetick;
+    stimer_wait_link(id);
+    #if !!(STIMER_ONESHOT_INDEX_ENABLE)
+    if (!waiting)
     {
-        /* 若到期时间超过计数上限则重置定时器时间刻*/
-        stimer_reset();
+        stimer_index_add(id);
     }
-    hstimer.ptasks[id].expire = hstimer.ptasks[id].interval + hstimer.timetick;
-    /* 将任务安排到计划表,等待列表中存在该任务则重新安排 */
+    #else
+    (void)waiting;
+    #endif
 
-    /* 查找并移除相同id的任务 */
-    for (i = 0; i < hstimer.wait_cnt; i++)
+    /* 执行调度钩子 */
+    #if !!(STIMER_TASK_HOOK_ENABLE)
+    if (hstimer.task_schedule_hook != NULL)
     {
-        if (id == min)
-        {
-            if (id == hstimer.wait_id)
-            {
-                hstimer.wait_id = hstimer.ptasks[min].next_id;
-            }
-            else
-            {
-                hstimer.ptasks[lmin].next_id = hstimer.ptasks[id].next_id;
-            }
-            hstimer.wait_cnt--;
-            break;
-        }
-        lmin = min;
-        min = hstimer.ptasks[min].next_id;
+        hstimer.task_schedule_hook(id);
     }
+    #endif
+
+}
+
+/**
+ * @brief Run the stimer tick
+ * @note Call this function in systick interrupt
+ */
+void stimer_tick_increase(void)
+{
+    #if !!(STIMER_TIME_64BIT_ENABLE)
+    hstimer.timetick++;
+    #else
+    if (++hstimer.timetick == 0)
+    {
+        hstimer.reset_cnt++;
+    }
+    #endif
+}
+
+/**
+ * @brief Stop a stimer task
+ * @param id task id
+ * @note If the task is reserved, it needs to be cancelled first
+ */
+void stimer_task_stop(uint16_t id)
+{
+    STIMER_ASSERT(id < hstimer.size);
+
+    uint8_t flag;
+    STIMER_DISABLE_INTERRUPTS();
+    flag = stimer_wait_unlink(id);
+    #if !!(STIMER_ONESHOT_INDEX_ENABLE)
+    if (flag == 1)
+    {
+        stimer_index_del(id);
+    }
+    #endif
+    if (hstimer.ptasks[id].reserved == 0 && flag == 1)
+    {
+        hstimer.ptasks[id].task_callback = NULL;
+        hstimer.ptasks[id].repetitions = 0;
+        hstimer.ptasks[id].reserved = 0;
+        /* 归还到空闲链表 */
+        hstimer.ptasks[id].next_id = hstimer.free_id;
+        hstimer.free_id = id;
+        hstimer.free_cnt++;
+    }
+    STIMER_ENABLE_INTERRUPTS();
+}
+
+#if ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_LIST)
+/*
+ * Sorted list wait queue
+ * Tasks are linked by next_id in order of expire, then priority,
+ * tasks with the same expire and priority keep their insertion order.
+ * STIMER_WAIT_DLIST_ENABLE adds prev_id so unlink and lookup are O(1),
+ * the extra memory per task is STIMER_WAIT_DLIST_COST bytes.
+ */
+static void stimer_wait_clear(void)
+{
+    #if !!(STIMER_WAIT_DLIST_ENABLE)
+    uint16_t i;
+    for (i = 0; i < hstimer.size; i++)
+    {
+        hstimer.ptasks[i].prev_id = STIMER_ID_NONE;
+    }
+    #endif
+    hstimer.wait_cnt = 0;
+}
+
+static void stimer_wait_link(uint16_t id)
+{
+    uint32_t i, min, lmin;
 
     /* 当前没有任务 */
     if (hstimer.wait_cnt == 0)
     {
         hstimer.wait_id = id;
+        #if !!(STIMER_WAIT_DLIST_ENABLE)
+        hstimer.ptasks[id].prev_id = id;
+        hstimer.ptasks[id].next_id = STIMER_ID_NONE;
+        #endif
         goto end;
     }
 
     /* 根据到期时间和优先级找到该任务安排的位置 */
     min = hstimer.wait_id;
+    lmin = hstimer.wait_id;
     for (i = 0; i < hstimer.wait_cnt; i++)
     {
-        if (hstimer.ptasks[min].expire > hstimer.ptasks[id].expire
+        if (STIMER_TIME_BEFORE(hstimer.ptasks[id].expire, hstimer.ptasks[min].expire)
             || (hstimer.ptasks[min].expire == hstimer.ptasks[id].expire
             && hstimer.ptasks[min].priority < hstimer.ptasks[id].priority))
         {
             hstimer.ptasks[id].next_id = min;
+            #if !!(STIMER_WAIT_DLIST_ENABLE)
+            hstimer.ptasks[id].prev_id = hstimer.ptasks[min].prev_id;
+            hstimer.ptasks[min].prev_id = id;
+            #endif
             if (min == hstimer.wait_id)
             {
                 hstimer.wait_id = id;
+                #if !!(STIMER_WAIT_DLIST_ENABLE)
+                hstimer.ptasks[id].prev_id = id;
+                #endif
             }
             else
             {
@@ -223,98 +335,713 @@ static void stimer_scheduler(uint16_t id)
     if (i == hstimer.wait_cnt)
     {
         hstimer.ptasks[lmin].next_id = id;
+        #if !!(STIMER_WAIT_DLIST_ENABLE)
+        hstimer.ptasks[id].prev_id = lmin;
+        hstimer.ptasks[id].next_id = STIMER_ID_NONE;
+        #endif
     }
 
     end:
     hstimer.wait_cnt++;
-    /* 执行调度钩子 */
-    #if !!(STIMER_TASK_HOOK_ENABLE)
-    if (hstimer.task_schedule_hook != NULL)
-    {
-        hstimer.task_schedule_hook(id);
-    }
-    #endif
-
 }
 
-/**
- * @brief Run the stimer tick
- * @note Call this function in systick interrupt
+#if !!(STIMER_WAIT_DLIST_ENABLE)
+/*
+ * Doubly linked list: prev_id is STIMER_ID_NONE when the task is not waiting,
+ * the head points to itself and the tail's next_id is STIMER_ID_NONE.
  */
-void stimer_tick_increase(void)
+static uint8_t stimer_wait_unlink(uint16_t id)
 {
-    hstimer.timetick++;
+    stimer_task_t *ptask = &hstimer.ptasks[id];
+    if (ptask->prev_id == STIMER_ID_NONE)
+    {
+        return 0;
+    }
+    if (id == hstimer.wait_id)
+    {
+        hstimer.wait_id = ptask->next_id;
+        if (ptask->next_id != STIMER_ID_NONE)
+        {
+            hstimer.ptasks[ptask->next_id].prev_id = ptask->next_id;
+        }
+    }
+    else
+    {
+        hstimer.ptasks[ptask->prev_id].next_id = ptask->next_id;
+        if (ptask->next_id != STIMER_ID_NONE)
+        {
+            hstimer.ptasks[ptask->next_id].prev_id = ptask->prev_id;
+        }
+    }
+    ptask->prev_id = STIMER_ID_NONE;
+    hstimer.wait_cnt--;
+    return 1;
 }
 
-static void stimer_reset(void)
+static uint8_t stimer_wait_contains(uint16_t id)
 {
-    stimer_time_t tick = hstimer.timetick;
-    uint16_t i;
-    stimer_task_t *ptask;
+    return hstimer.ptasks[id].prev_id != STIMER_ID_NONE;
+}
+#else
+static uint8_t stimer_wait_unlink(uint16_t id)
+{
+    uint32_t i, min, lmin;
+    min = hstimer.wait_id;
+    lmin = hstimer.wait_id;
 
-    if (hstimer.wait_cnt > 0)
+    /* 查找并移除相同id的任务 */
+    for (i = 0; i < hstimer.wait_cnt; i++)
     {
-        ptask = &hstimer.ptasks[hstimer.wait_id];
-        for (i = 0; i < hstimer.wait_cnt; i++)
+        if (id == min)
         {
-            if (ptask->expire > tick)
+            if (id == hstimer.wait_id)
             {
-                // 还未到期的任务
-                ptask->expire -= tick;
+                hstimer.wait_id = hstimer.ptasks[min].next_id;
             }
             else
             {
-                // 已到期的任务
-                ptask->expire = 0;
+                hstimer.ptasks[lmin].next_id = hstimer.ptasks[id].next_id;
             }
-            ptask = &hstimer.ptasks[ptask->next_id];
+            hstimer.wait_cnt--;
+            return 1;
         }
+        lmin = min;
+        min = hstimer.ptasks[min].next_id;
     }
-    hstimer.timetick = 0;
-    hstimer.reset_cnt++;
+    return 0;
 }
 
-/**
- * @brief Stop a stimer task
- * @param id task id
- * @note If the task is reserved, it needs to be cancelled first
+static uint8_t stimer_wait_contains(uint16_t id)
+{
+    uint16_t i, min = hstimer.wait_id;
+    for (i = 0; i < hstimer.wait_cnt; i++)
+    {
+        if (min == id)
+        {
+            return 1;
+        }
+        min = hstimer.ptasks[min].next_id;
+    }
+    return 0;
+}
+#endif
+
+static uint16_t stimer_wait_first(void)
+{
+    return hstimer.wait_cnt ? hstimer.wait_id : STIMER_ID_NONE;
+}
+
+static uint16_t stimer_wait_due(stimer_time_t now)
+{
+    if (hstimer.wait_cnt && !STIMER_TIME_BEFORE(now, hstimer.ptasks[hstimer.wait_id].expire))
+    {
+        return hstimer.wait_id;
+    }
+    return STIMER_ID_NONE;
+}
+
+static uint16_t stimer_wait_find_callback(stimer_pfunc_t task_callback)
+{
+    uint16_t i, id = hstimer.wait_id;
+    for (i = 0; i < hstimer.wait_cnt; i++)
+    {
+        if (hstimer.ptasks[id].task_callback == task_callback && hstimer.ptasks[id].reserved == 0)
+        {
+            return id;
+        }
+        id = hstimer.ptasks[id].next_id;
+    }
+    return STIMER_ID_NONE;
+}
+
+#elif ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_WHEEL)
+/*
+ * Hierarchical timing wheel wait queue
+ * Level n slot covers STIMER_WHEEL_SLOTS^n ticks. A task is placed on the lowest
+ * level where its expire shares all higher bits with wheel_time, so every task of
+ * level n expires before any task of level n+1. Tasks beyond the wheel range are
+ * kept in the overflow list and placed again when wheel_time crosses the range.
+ * Level 0 slots hold tasks expiring on the same tick, sorted by priority.
+ * Start, stop and expiry are O(1) apart from same tick priority ordering.
  */
-void stimer_task_stop(uint16_t id)
+#define STIMER_WHEEL_MASK     (STIMER_WHEEL_SLOTS - 1)
+#define STIMER_WHEEL_OVERFLOW (STIMER_WHEEL_LEVELS * STIMER_WHEEL_SLOTS)
+#define STIMER_WHEEL_RANGE    ((stimer_time_t)1 << (STIMER_WHEEL_LEVELS * STIMER_WHEEL_SLOT_BIT))
+
+static uint8_t stimer_wait_before(uint16_t a, uint16_t b)
 {
-    STIMER_ASSERT(id < hstimer.size);
+    stimer_task_t *pa = &hstimer.ptasks[a];
+    stimer_task_t *pb = &hstimer.ptasks[b];
+    return STIMER_TIME_BEFORE(pa->expire, pb->expire)
+           || (pa->expire == pb->expire && pa->priority > pb->priority);
+}
 
-    uint32_t i;
-    stimer_task_t *ptask = &hstimer.ptasks[hstimer.wait_id];
-    int flag = 0;
-    STIMER_DISABLE_INTERRUPTS();
-    if (id == hstimer.wait_id && hstimer.wait_cnt > 0)
+static uint16_t stimer_wheel_ctz(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return (uint16_t)__builtin_ctzll(bits);
+#else
+    uint16_t n = 0;
+    while ((bits & 1) == 0)
     {
-        hstimer.wait_id = ptask->next_id;
-        hstimer.wait_cnt--;
-        flag = 1;
+        bits >>= 1;
+        n++;
     }
-    else
+    return n;
+#endif
+}
+
+/* 查找该层不小于pos的第一个非空槽,不存在则返回STIMER_WHEEL_SLOTS */
+static uint16_t stimer_wheel_next_slot(uint16_t level, uint16_t pos)
+{
+    uint64_t bits;
+    if (pos >= STIMER_WHEEL_SLOTS)
+    {
+        return STIMER_WHEEL_SLOTS;
+    }
+    bits = hstimer.wheel_bitmap[level] & (~0ULL << pos);
+    return bits ? stimer_wheel_ctz(bits) : STIMER_WHEEL_SLOTS;
+}
+
+static uint16_t stimer_wheel_slot(stimer_time_t expire)
+{
+    stimer_time_t diff;
+    uint16_t level;
+    if (STIMER_TIME_BEFORE(expire, hstimer.wheel_time))
+    {
+        /* 已到期的任务放入当前槽 */
+        expire = hstimer.wheel_time;
+    }
+    diff = expire ^ hstimer.wheel_time;
+    for (level = 0; level < STIMER_WHEEL_LEVELS; level++)
+    {
+        if ((diff >> ((level + 1) * STIMER_WHEEL_SLOT_BIT)) == 0)
+        {
+            return level * STIMER_WHEEL_SLOTS
+                   + ((expire >> (level * STIMER_WHEEL_SLOT_BIT)) & STIMER_WHEEL_MASK);
+        }
+    }
+    return STIMER_WHEEL_OVERFLOW;
+}
+
+static void stimer_wheel_insert(uint16_t id)
+{
+    stimer_task_t *ptask = &hstimer.ptasks[id];
+    uint16_t slot = stimer_wheel_slot(ptask->expire);
+    uint16_t head = hstimer.wheel_head[slot];
+    uint16_t pos;
+
+    ptask->slot = slot;
+    ptask->next_id = STIMER_ID_NONE;
+    if (head == STIMER_ID_NONE)
     {
-        for (i = 1; i < hstimer.wait_cnt; i++)
+        ptask->prev_id = id;
+        hstimer.wheel_head[slot] = id;
+        if (slot < STIMER_WHEEL_OVERFLOW)
         {
-            if (ptask->next_id == id)
+            hstimer.wheel_bitmap[slot / STIMER_WHEEL_SLOTS] |= 1ULL << (slot & STIMER_WHEEL_MASK);
+        }
+        return;
+    }
+
+    /* 从链表尾开始查找,第0层槽内按优先级排序,其他槽直接加到链表尾 */
+    pos = hstimer.ptasks[head].prev_id;
+    if (slot < STIMER_WHEEL_SLOTS)
+    {
+        while (hstimer.ptasks[pos].priority < ptask->priority)
+        {
+            if (pos == head)
             {
-                ptask->next_id = hstimer.ptasks[id].next_id;
-                hstimer.wait_cnt--;
-                flag = 1;
-                break;
+                ptask->next_id = head;
+                ptask->prev_id = hstimer.ptasks[head].prev_id;
+                hstimer.ptasks[head].prev_id = id;
+                hstimer.wheel_head[slot] = id;
+                return;
             }
-            ptask = &hstimer.ptasks[ptask->next_id];
+            pos = hstimer.ptasks[pos].prev_id;
         }
     }
-    if (hstimer.ptasks[id].reserved == 0 && flag == 1)
+    ptask->next_id = hstimer.ptasks[pos].next_id;
+    ptask->prev_id = pos;
+    hstimer.ptasks[pos].next_id = id;
+    if (ptask->next_id == STIMER_ID_NONE)
     {
-        hstimer.ptasks[id].task_callback = NULL;
-        hstimer.ptasks[id].repetitions = 0;
-        hstimer.ptasks[id].reserved = 0;
+        hstimer.ptasks[head].prev_id = id;
+    }
+    else
+    {
+        hstimer.ptasks[ptask->next_id].prev_id = id;
+    }
+}
+
+static void stimer_wheel_remove(uint16_t id)
+{
+    stimer_task_t *ptask = &hstimer.ptasks[id];
+    uint16_t slot = ptask->slot;
+    uint16_t head = hstimer.wheel_head[slot];
+
+    if (id == head)
+    {
+        head = ptask->next_id;
+        hstimer.wheel_head[slot] = head;
+        if (head != STIMER_ID_NONE)
+        {
+            hstimer.ptasks[head].prev_id = ptask->prev_id;
+        }
+        else if (slot < STIMER_WHEEL_OVERFLOW)
+        {
+            hstimer.wheel_bitmap[slot / STIMER_WHEEL_SLOTS] &= ~(1ULL << (slot & STIMER_WHEEL_MASK));
+        }
+    }
+    else
+    {
+        hstimer.ptasks[ptask->prev_id].next_id = ptask->next_id;
+        if (ptask->next_id != STIMER_ID_NONE)
+        {
+            hstimer.ptasks[ptask->next_id].prev_id = ptask->prev_id;
+        }
+        else
+        {
+            hstimer.ptasks[head].prev_id = ptask->prev_id;
+        }
+    }
+    ptask->slot = STIMER_ID_NONE;
+}
+
+/* 将槽内的任务按当前时间重新放入时间轮 */
+static void stimer_wheel_cascade(uint16_t slot)
+{
+    uint16_t id = hstimer.wheel_head[slot];
+    uint16_t next;
+
+    hstimer.wheel_head[slot] = STIMER_ID_NONE;
+    if (slot < STIMER_WHEEL_OVERFLOW)
+    {
+        hstimer.wheel_bitmap[slot / STIMER_WHEEL_SLOTS] &= ~(1ULL << (slot & STIMER_WHEEL_MASK));
+    }
+    while (id != STIMER_ID_NONE)
+    {
+        next = hstimer.ptasks[id].next_id;
+        stimer_wheel_insert(id);
+        id = next;
+    }
+}
+
+/* 查找下一个非空槽及其开始时刻 */
+static uint16_t stimer_wheel_next_event(stimer_time_t *time)
+{
+    stimer_time_t now = hstimer.wheel_time;
+    uint16_t level, shift, pos;
+
+    for (level = 0; level < STIMER_WHEEL_LEVELS; level++)
+    {
+        shift = level * STIMER_WHEEL_SLOT_BIT;
+        /* 第0层包含当前槽,更高层的当前槽在进入时已经展开 */
+        pos = ((now >> shift) & STIMER_WHEEL_MASK) + (level ? 1 : 0);
+        pos = stimer_wheel_next_slot(level, pos);
+        if (pos < STIMER_WHEEL_SLOTS)
+        {
+            *time = (now & ~((((stimer_time_t)1) << (shift + STIMER_WHEEL_SLOT_BIT)) - 1))
+                    | ((stimer_time_t)pos << shift);
+            return level * STIMER_WHEEL_SLOTS + pos;
+        }
+    }
+    if (hstimer.wheel_head[STIMER_WHEEL_OVERFLOW] != STIMER_ID_NONE)
+    {
+        *time = (now | (STIMER_WHEEL_RANGE - 1)) + 1;
+        return STIMER_WHEEL_OVERFLOW;
+    }
+    return STIMER_ID_NONE;
+}
+
+/* 以新的时间重建时间轮 */
+static void stimer_wheel_rebuild(stimer_time_t time)
+{
+    uint16_t i, chain = STIMER_ID_NONE;
+
+    for (i = hstimer.size; i > 0; i--)
+    {
+        stimer_task_t *ptask = &hstimer.ptasks[i - 1];
+        if (ptask->slot == STIMER_ID_NONE)
+        {
+            continue;
+        }
+        stimer_wheel_remove(i - 1);
+        ptask->next_id = chain;
+        chain = i - 1;
+    }
+    hstimer.wheel_time = time;
+    while (chain != STIMER_ID_NONE)
+    {
+        i = chain;
+        chain = hstimer.ptasks[i].next_id;
+        stimer_wheel_insert(i);
+    }
+}
+
+static void stimer_wait_clear(void)
+{
+    uint16_t i;
+    hstimer.wait_cnt = 0;
+    hstimer.wheel_time = hstimer.timetick;
+    memset(hstimer.wheel_bitmap, 0, sizeof(hstimer.wheel_bitmap));
+    memset(hstimer.wheel_head, 0xFF, sizeof(hstimer.wheel_head));
+    for (i = 0; i < hstimer.size; i++)
+    {
+        hstimer.ptasks[i].slot = STIMER_ID_NONE;
+    }
+}
+
+static void stimer_wait_link(uint16_t id)
+{
+    if (hstimer.wait_cnt == 0)
+    {
+        hstimer.wheel_time = hstimer.timetick;
+    }
+    stimer_wheel_insert(id);
+    hstimer.wait_cnt++;
+}
+
+static uint8_t stimer_wait_unlink(uint16_t id)
+{
+    if (hstimer.ptasks[id].slot == STIMER_ID_NONE)
+    {
+        return 0;
+    }
+    stimer_wheel_remove(id);
+    hstimer.wait_cnt--;
+    return 1;
+}
+
+static uint8_t stimer_wait_contains(uint16_t id)
+{
+    return hstimer.ptasks[id].slot != STIMER_ID_NONE;
+}
+
+static uint16_t stimer_wait_first(void)
+{
+    stimer_time_t time;
+    uint16_t slot, id, min;
+
+    if (hstimer.wait_cnt == 0)
+    {
+        return STIMER_ID_NONE;
+    }
+    slot = stimer_wheel_next_event(&time);
+    STIMER_ASSERT(slot != STIMER_ID_NONE);
+    min = hstimer.wheel_head[slot];
+    if (slot < STIMER_WHEEL_SLOTS)
+    {
+        return min;
+    }
+    /* 高层槽和溢出链表内未排序,查找最早到期的任务 */
+    for (id = hstimer.ptasks[min].next_id; id != STIMER_ID_NONE; id = hstimer.ptasks[id].next_id)
+    {
+        if (stimer_wait_before(id, min))
+        {
+            min = id;
+        }
+    }
+    return min;
+}
+
+static uint16_t stimer_wait_due(stimer_time_t now)
+{
+    stimer_time_t time;
+    uint16_t slot;
+
+    while (hstimer.wait_cnt)
+    {
+        slot = stimer_wheel_next_event(&time);
+        STIMER_ASSERT(slot != STIMER_ID_NONE);
+        if (STIMER_TIME_BEFORE(now, time))
+        {
+            break;
+        }
+        hstimer.wheel_time = time;
+        if (slot < STIMER_WHEEL_SLOTS)
+        {
+            return hstimer.wheel_head[slot];
+        }
+        /* 进入高层槽的时间范围,将其展开到低层 */
+        stimer_wheel_cascade(slot);
+    }
+    return STIMER_ID_NONE;
+}
+
+static uint16_t stimer_wait_find_callback(stimer_pfunc_t task_callback)
+{
+    uint16_t id;
+    for (id = 0; id < hstimer.size; id++)
+    {
+        if (hstimer.ptasks[id].slot != STIMER_ID_NONE
+            && hstimer.ptasks[id].task_callback == task_callback
+            && hstimer.ptasks[id].reserved == 0)
+        {
+            return id;
+        }
+    }
+    return STIMER_ID_NONE;
+}
+#elif ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_HEAP)
+/*
+ * Binary min-heap wait queue
+ * The heap array is stored in the heap_node field of the task buffer and every
+ * task records its own heap_pos, so start, stop and reschedule are O(log n)
+ * without extra memory. The key is (expire, priority, seq), seq keeps tasks
+ * with the same expire and priority in insertion order like the sorted list.
+ */
+#define STIMER_HEAP_NODE(pos) (hstimer.ptasks[pos].heap_node)
+
+static uint8_t stimer_wait_before(uint16_t a, uint16_t b)
+{
+    stimer_task_t *pa = &hstimer.ptasks[a];
+    stimer_task_t *pb = &hstimer.ptasks[b];
+    if (pa->expire != pb->expire)
+    {
+        return STIMER_TIME_BEFORE(pa->expire, pb->expire);
+    }
+    if (pa->priority != pb->priority)
+    {
+        return pa->priority > pb->priority;
+    }
+    return (int32_t)(pa->seq - pb->seq) < 0;
+}
+
+static void stimer_heap_set(uint16_t pos, uint16_t id)
+{
+    STIMER_HEAP_NODE(pos) = id;
+    hstimer.ptasks[id].heap_pos = pos;
+}
+
+static void stimer_heap_sift_up(uint16_t pos)
+{
+    uint16_t id = STIMER_HEAP_NODE(pos);
+    uint16_t parent;
+    while (pos > 0)
+    {
+        parent = (pos - 1) >> 1;
+        if (!stimer_wait_before(id, STIMER_HEAP_NODE(parent)))
+        {
+            break;
+        }
+        stimer_heap_set(pos, STIMER_HEAP_NODE(parent));
+        pos = parent;
+    }
+    stimer_heap_set(pos, id);
+}
+
+static void stimer_heap_sift_down(uint16_t pos)
+{
+    uint16_t id = STIMER_HEAP_NODE(pos);
+    uint32_t child;
+    while ((child = ((uint32_t)pos << 1) + 1) < hstimer.wait_cnt)
+    {
+        if (child + 1 < hstimer.wait_cnt
+            && stimer_wait_before(STIMER_HEAP_NODE(child + 1), STIMER_HEAP_NODE(child)))
+        {
+            child++;
+        }
+        if (!stimer_wait_before(STIMER_HEAP_NODE(child), id))
+        {
+            break;
+        }
+        stimer_heap_set(pos, STIMER_HEAP_NODE(child));
+        pos = child;
+    }
+    stimer_heap_set(pos, id);
+}
+
+static void stimer_wait_clear(void)
+{
+    uint16_t i;
+    hstimer.wait_cnt = 0;
+    hstimer.heap_seq = 0;
+    for (i = 0; i < hstimer.size; i++)
+    {
+        hstimer.ptasks[i].heap_pos = STIMER_ID_NONE;
+    }
+}
+
+static void stimer_wait_link(uint16_t id)
+{
+    hstimer.ptasks[id].seq = hstimer.heap_seq++;
+    STIMER_HEAP_NODE(hstimer.wait_cnt) = id;
+    hstimer.wait_cnt++;
+    stimer_heap_sift_up(hstimer.wait_cnt - 1);
+}
+
+static uint8_t stimer_wait_unlink(uint16_t id)
+{
+    uint16_t pos = hstimer.ptasks[id].heap_pos;
+    uint16_t last;
+    if (pos == STIMER_ID_NONE)
+    {
+        return 0;
+    }
+    hstimer.ptasks[id].heap_pos = STIMER_ID_NONE;
+    hstimer.wait_cnt--;
+    if (pos < hstimer.wait_cnt)
+    {
+        /* 用堆尾的任务填补空位,再向下或向上调整 */
+        last = STIMER_HEAP_NODE(hstimer.wait_cnt);
+        STIMER_HEAP_NODE(pos) = last;
+        stimer_heap_sift_down(pos);
+        stimer_heap_sift_up(hstimer.ptasks[last].heap_pos);
+    }
+    return 1;
+}
+
+static uint8_t stimer_wait_contains(uint16_t id)
+{
+    return hstimer.ptasks[id].heap_pos != STIMER_ID_NONE;
+}
+
+static uint16_t stimer_wait_first(void)
+{
+    return hstimer.wait_cnt ? STIMER_HEAP_NODE(0) : STIMER_ID_NONE;
+}
+
+static uint16_t stimer_wait_due(stimer_time_t now)
+{
+    if (hstimer.wait_cnt && !STIMER_TIME_BEFORE(now, hstimer.ptasks[STIMER_HEAP_NODE(0)].expire))
+    {
+        return STIMER_HEAP_NODE(0);
+    }
+    return STIMER_ID_NONE;
+}
+
+static uint16_t stimer_wait_find_callback(stimer_pfunc_t task_callback)
+{
+    uint16_t i, id;
+    for (i = 0; i < hstimer.wait_cnt; i++)
+    {
+        id = STIMER_HEAP_NODE(i);
+        if (hstimer.ptasks[id].task_callback == task_callback && hstimer.ptasks[id].reserved == 0)
+        {
+            return id;
+        }
+    }
+    return STIMER_ID_NONE;
+}
+#endif
+
+#if !!(STIMER_ONESHOT_INDEX_ENABLE)
+/*
+ * Oneshot callback index
+ * Open addressing hash table with linear probing, mapping the callback of every
+ * waiting task to its id. Deletion shifts the following entries back, so there
+ * are no tombstones and lookups stay O(1) under constant churn.
+ */
+static uint16_t stimer_index_hash(stimer_pfunc_t task_callback)
+{
+    uint64_t key = (uint64_t)(uintptr_t)task_callback;
+    uint32_t hash = (uint32_t)(key ^ (key >> 32));
+    hash ^= hash >> 16;
+    hash *= 0x45D9F3BU;
+    hash ^= hash >> 16;
+    return (uint16_t)(hash & hstimer.index_mask);
+}
+
+static void stimer_index_clear(void)
+{
+    if (hstimer.index != NULL)
+    {
+        memset(hstimer.index, 0xFF, sizeof(uint16_t) * (hstimer.index_mask + 1U));
+    }
+}
+
+static void stimer_index_add(uint16_t id)
+{
+    uint16_t i;
+    if (hstimer.index == NULL)
+    {
+        return;
+    }
+    i = stimer_index_hash(hstimer.ptasks[id].task_callback);
+    while (hstimer.index[i] != STIMER_ID_NONE)
+    {
+        i = (i + 1) & hstimer.index_mask;
+    }
+    hstimer.index[i] = id;
+}
+
+static void stimer_index_del(uint16_t id)
+{
+    uint16_t i, j, home;
+    if (hstimer.index == NULL)
+    {
+        return;
+    }
+    i = stimer_index_hash(hstimer.ptasks[id].task_callback);
+    while (hstimer.index[i] != id)
+    {
+        if (hstimer.index[i] == STIMER_ID_NONE)
+        {
+            return;
+        }
+        i = (i + 1) & hstimer.index_mask;
+    }
+    /* 将后续探测链上的元素前移,填补空位 */
+    j = i;
+    while (1)
+    {
+        j = (j + 1) & hstimer.index_mask;
+        if (hstimer.index[j] == STIMER_ID_NONE)
+        {
+            break;
+        }
+        home = stimer_index_hash(hstimer.ptasks[hstimer.index[j]].task_callback);
+        if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+        {
+            continue;
+        }
+        hstimer.index[i] = hstimer.index[j];
+        i = j;
+    }
+    hstimer.index[i] = STIMER_ID_NONE;
+}
+
+static uint16_t stimer_index_find(stimer_pfunc_t task_callback)
+{
+    uint16_t i = stimer_index_hash(task_callback);
+    uint16_t id;
+    while ((id = hstimer.index[i]) != STIMER_ID_NONE)
+    {
+        if (hstimer.ptasks[id].task_callback == task_callback && hstimer.ptasks[id].reserved == 0)
+        {
+            return id;
+        }
+        i = (i + 1) & hstimer.index_mask;
+    }
+    return STIMER_ID_NONE;
+}
+
+/**
+ * @brief Set the oneshot callback index buffer
+ * @param index index buffer
+ * @param size buffer length, a power of two larger than the task list size
+ * @note stimer_task_oneshot() finds the waiting task with the same callback in O(1)
+ */
+void stimer_set_oneshot_index(uint16_t *index, uint16_t size)
+{
+    uint16_t id;
+    STIMER_ASSERT(index == NULL || (size > hstimer.size && (size & (size - 1)) == 0));
+    STIMER_DISABLE_INTERRUPTS();
+    hstimer.index = index;
+    hstimer.index_mask = index != NULL ? size - 1 : 0;
+    stimer_index_clear();
+    /* 索引当前等待中的任务 */
+    for (id = 0; index != NULL && id < hstimer.size; id++)
+    {
+        if (stimer_wait_contains(id))
+        {
+            stimer_index_add(id);
+        }
     }
     STIMER_ENABLE_INTERRUPTS();
 }
+#endif
 
 /**
  * @brief Stimer serve function
@@ -322,10 +1049,10 @@ void stimer_task_stop(uint16_t id)
  */
 void stimer_serve(void)
 {
+    uint16_t current_id;
     /* 判断任务是否到期 */
-    while (hstimer.wait_cnt && hstimer.ptasks[hstimer.wait_id].expire <= hstimer.timetick)
+    while ((current_id = stimer_wait_due(hstimer.timetick)) != STIMER_ID_NONE)
     {
-        uint16_t current_id = hstimer.wait_id;
         STIMER_ASSERT(current_id < hstimer.size);
         STIMER_ASSERT(hstimer.ptasks[current_id].repetitions > 0);
         STIMER_ASSERT(hstimer.ptasks[current_id].task_callback != NULL);
@@ -391,7 +1118,8 @@ uint16_t stiemr_get_waitCnt(void)
 
 uint16_t stimer_get_waitID(void)
 {
-    return hstimer.wait_id;
+    uint16_t id = stimer_wait_first();
+    return id != STIMER_ID_NONE ? id : hstimer.wait_id;
 }
 
 /**
@@ -401,14 +1129,32 @@ uint16_t stimer_get_waitID(void)
  */
 stimer_time_t stimer_get_nextExpire(void)
 {
-    if (hstimer.wait_cnt == 0) return 0;
-    return hstimer.ptasks[hstimer.wait_id].expire;
+    uint16_t id = stimer_wait_first();
+    if (id == STIMER_ID_NONE) return 0;
+    return hstimer.ptasks[id].expire;
 }
 
+#if !(STIMER_TIME_64BIT_ENABLE)
+/**
+ * @brief Obtain the number of tick counter wraps
+ * @retval uint16_t wrap count
+ * @note Waiting tasks are no longer rebased when the counter wraps
+ */
 uint16_t stimer_get_resetCnt(void)
 {
     return hstimer.reset_cnt;
 }
+#endif
+
+/**
+ * @brief Obtain the number of free task slots
+ * @retval uint16_t free task slots
+ * @note Reserved tasks and tasks that are created but not started are not free
+ */
+uint16_t stimer_get_free_cnt(void)
+{
+    return hstimer.free_cnt;
+}
 
 /**
  * @brief Using ID to find waiting task
@@ -418,30 +1164,11 @@ uint16_t stimer_get_resetCnt(void)
 stimer_task_t *stimer_find_waitTask(uint16_t id)
 {
     STIMER_ASSERT(id < hstimer.size);
-    uint16_t i;
-    stimer_task_t *ptask;
 
-    if (hstimer.ptasks[id].reserved)
-    {
-        return &hstimer.ptasks[id];
-    }
-    if (hstimer.wait_cnt == 0)
-    {
-        return NULL;
-    }
-    if (hstimer.wait_id == id)
+    if (hstimer.ptasks[id].reserved || stimer_wait_contains(id))
     {
         return &hstimer.ptasks[id];
     }
-    ptask = &hstimer.ptasks[hstimer.wait_id];
-    for (i = 1; i < hstimer.wait_cnt; i++)
-    {
-        if (ptask->next_id == id)
-        {
-            return &hstimer.ptasks[ptask->next_id];
-        }
-        ptask = &hstimer.ptasks[ptask->next_id];
-    }
     return NULL;
 }
 
@@ -478,12 +1205,29 @@ void *stimer_task_get_callback(uint16_t id)
 void stimer_set_waitCnt(uint16_t waitCnt)
 {
     STIMER_ASSERT(waitCnt < hstimer.size);
-    hstimer.wait_cnt = waitCnt;
+    if (waitCnt == 0)
+    {
+        stimer_wait_clear();
+        #if !!(STIMER_ONESHOT_INDEX_ENABLE)
+        stimer_index_clear();
+        #endif
+    }
+    else
+    {
+        hstimer.wait_cnt = waitCnt;
+    }
 }
 
 void stimer_set_tick(stimer_time_t tick)
 {
     hstimer.timetick = tick;
+    #if ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_WHEEL)
+    /* 时间回拨时需要重建时间轮 */
+    if (hstimer.wait_cnt == 0 || STIMER_TIME_BEFORE(tick, hstimer.wheel_time))
+    {
+        stimer_wheel_rebuild(tick);
+    }
+    #endif
 }
 
 #if !!(STIMER_TASK_ARG_ENABLE)
@@ -528,7 +1272,21 @@ void stimer_task_set_repetitions(uint16_t id, uint16_t repetitions)
 void stimer_task_set_callback(uint16_t id, stimer_pfunc_t task_callback)
 {
     STIMER_ASSERT(id < hstimer.size);
+    #if !!(STIMER_ONESHOT_INDEX_ENABLE)
+    /* 回调函数是索引的键值,修改前后需要更新索引 */
+    uint8_t waiting = stimer_wait_contains(id);
+    if (waiting)
+    {
+        stimer_index_del(id);
+    }
+    hstimer.ptasks[id].task_callback = task_callback;
+    if (waiting)
+    {
+        stimer_index_add(id);
+    }
+    #else
     hstimer.ptasks[id].task_callback = task_callback;
+    #endif
 }
 
 /**
@@ -542,6 +1300,7 @@ uint16_t stimer_get_wait_table(uint16_t* task_table, stimer_time_t* time_table,
 {
     STIMER_ASSERT(task_table != NULL);
     STIMER_ASSERT(time_table != NULL);
+#if ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_LIST)
     uint16_t i, id;
     size = hstimer.wait_cnt > size ? size : hstimer.wait_cnt;
     id = hstimer.wait_id;
@@ -552,6 +1311,41 @@ uint16_t stimer_get_wait_table(uint16_t* task_table, stimer_time_t* time_table,
         id = hstimer.ptasks[id].next_id;
     }
     return size;
+#else
+    uint16_t i, j, id, cnt = 0;
+    for (id = 0; id < hstimer.size; id++)
+    {
+        if (!stimer_wait_contains(id))
+        {
+            continue;
+        }
+        /* 按到期时间和优先级插入排序,只保留最早的size个任务 */
+        for (j = cnt; j > 0; j--)
+        {
+            if (!stimer_wait_before(id, task_table[j - 1]))
+            {
+                break;
+            }
+            if (j < size)
+            {
+                task_table[j] = task_table[j - 1];
+            }
+        }
+        if (j < size)
+        {
+            task_table[j] = id;
+        }
+        if (cnt < size)
+        {
+            cnt++;
+        }
+    }
+    for (i = 0; i < cnt; i++)
+    {
+        time_table[i] = hstimer.ptasks[task_table[i]].expire;
+    }
+    return cnt;
+#endif
 }
 
 #if !!(STIMER_TASK_HOOK_ENABLE)
@@ -35,6 +35,7 @@
 |                               INCLUDES                                |
 -----------------------------------------------------------------------*/
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef  __cplusplus
     extern "C" {
@@ -58,6 +59,27 @@
 #define STIMER_MAX_REPETITIONS_BIT    (11)
 // Using task priority bits [1~4]
 #define STIMER_MAX_PRIORITY_BIT       (4)
+// Using 64-bit time base [0:uint32_t, 1:uint64_t, no counter wrap handling]
+#ifndef STIMER_TIME_64BIT_ENABLE
+#define STIMER_TIME_64BIT_ENABLE      (0)
+#endif
+// Wait queue backend [0:sorted list] [1:hierarchical timing wheel]
+//                    [2:binary min-heap]
+#ifndef STIMER_WAIT_QUEUE
+#define STIMER_WAIT_QUEUE             (0)
+#endif
+// Timing wheel levels [1~4], each level covers STIMER_WHEEL_SLOT_BIT bits
+#define STIMER_WHEEL_LEVELS           (4)
+// Timing wheel slots per level, in bits [1~6]
+#define STIMER_WHEEL_SLOT_BIT         (6)
+// Using doubly linked sorted list, O(1) stop and lookup [0:disable, 1:enable]
+#ifndef STIMER_WAIT_DLIST_ENABLE
+#define STIMER_WAIT_DLIST_ENABLE      (0)
+#endif
+// Using oneshot callback hash index [0:disable, 1:enable]
+#ifndef STIMER_ONESHOT_INDEX_ENABLE
+#define STIMER_ONESHOT_INDEX_ENABLE   (0)
+#endif
 // Task Critical section start [example:__disable_irq()]
 extern void __disable_irq(void);
 #define STIMER_DISABLE_INTERRUPTS()   __disable_irq()
@@ -93,9 +115,34 @@ do { \
 #define STIMER_MAX_REPETITIONS ((1 << STIMER_MAX_REPETITIONS_BIT) - 1)
 #define STIMER_MAX_PRIORITY ((1 << STIMER_MAX_PRIORITY_BIT) - 1)
 #define STIMER_MAX_TIMETICK ((((1ULL << ((sizeof(stimer_time_t)*8) - 1)) - 1) << 1) + 1)
+// The tick counter wraps freely, intervals must stay within half of its range
+#define STIMER_MAX_INTERVAL (STIMER_MAX_TIMETICK >> 1)
 #define STIMER_TASK_LOOP STIMER_MAX_REPETITIONS
+#define STIMER_ID_NONE (0xFFFF)
+
+#define STIMER_WAIT_QUEUE_LIST  (0)
+#define STIMER_WAIT_QUEUE_WHEEL (1)
+#define STIMER_WAIT_QUEUE_HEAP  (2)
+
+#if ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_WHEEL)
+#if ((STIMER_WHEEL_SLOT_BIT) < 1 || (STIMER_WHEEL_SLOT_BIT) > 6)
+#error "Unsupported STIMER_WHEEL_SLOT_BIT value"
+#endif
+#if ((STIMER_WHEEL_LEVELS) < 1 || (STIMER_WHEEL_LEVELS) * (STIMER_WHEEL_SLOT_BIT) >= 32)
+#error "Unsupported STIMER_WHEEL_LEVELS value"
+#endif
+#define STIMER_WHEEL_SLOTS (1 << STIMER_WHEEL_SLOT_BIT)
+#elif ((STIMER_WAIT_QUEUE) != STIMER_WAIT_QUEUE_LIST && (STIMER_WAIT_QUEUE) != STIMER_WAIT_QUEUE_HEAP)
+#error "Unsupported STIMER_WAIT_QUEUE value"
+#endif
 
+#if !!(STIMER_TIME_64BIT_ENABLE)
+typedef uint64_t stimer_time_t;
+typedef int64_t stimer_stime_t;
+#else
 typedef uint32_t stimer_time_t;
+typedef int32_t stimer_stime_t;
+#endif
 typedef struct stimer_structure_type stimer_t;
 typedef struct stimer_task_structure_type stimer_task_t;
 typedef void (*stimer_pfunc_t)(const void * arg);
@@ -107,9 +154,26 @@ struct stimer_structure_type
     uint16_t size;           // 任务列表总长度
     uint16_t wait_cnt;       // 等待列表的任务量
     uint16_t wait_id;        // 等待中的任务id
-    uint16_t reset_cnt;      // 重置计数
+#if !(STIMER_TIME_64BIT_ENABLE)
+    uint16_t reset_cnt;      // 时刻计数回绕次数
+#endif
+    uint16_t free_id;        // 空闲任务链表头,由next_id串联
+    uint16_t free_cnt;       // 空闲任务数量
+
+#if !!(STIMER_ONESHOT_INDEX_ENABLE)
+    uint16_t *index;         // 回调函数到任务id的哈希索引,由用户提供
+    uint16_t index_mask;     // 哈希索引长度-1
+#endif
     stimer_time_t timetick;  // 当前时刻
 
+#if ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_WHEEL)
+    stimer_time_t wheel_time; // 时间轮已推进到的时刻
+    uint64_t wheel_bitmap[STIMER_WHEEL_LEVELS];  // 各层非空槽位图
+    uint16_t wheel_head[STIMER_WHEEL_LEVELS * STIMER_WHEEL_SLOTS + 1]; // 槽链表头,最后一个为溢出链表
+#elif ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_HEAP)
+    uint32_t heap_seq;        // 入堆序号,保证同到期同优先级的任务先进先出
+#endif
+
 #if !!(STIMER_ASSERT_ENABLE)
     void (*user_assert_callback)(const char *FILE_NAME, uint32_t LINE_NAME);
 #endif
@@ -132,23 +196,53 @@ struct stimer_task_structure_type
     uint16_t priority:STIMER_MAX_PRIORITY_BIT;       // 优先级[0,STIMER_MAX_PRIORITY], 最小优先级为0
     uint16_t next_id;
 
+#if ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_WHEEL)
+    uint16_t prev_id;       // 槽链表前驱,链表头的前驱为链表尾
+    uint16_t slot;          // 所在槽位,STIMER_ID_NONE表示不在等待列表
+#elif ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_HEAP)
+    uint16_t heap_pos;      // 任务在堆中的位置,STIMER_ID_NONE表示不在等待列表
+    uint16_t heap_node;     // 堆数组: 堆中第[本任务下标]个位置的任务id
+    uint32_t seq;           // 入堆序号
+#endif
+
 #if !!(STIMER_TASK_ARG_ENABLE)
     void *arg;
 #endif
+
+#if ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_LIST) && !!(STIMER_WAIT_DLIST_ENABLE)
+    uint16_t prev_id;       // 等待列表前驱,STIMER_ID_NONE表示不在等待列表,必须是最后一个成员
+#endif
 };
 
+#if ((STIMER_WAIT_QUEUE) == STIMER_WAIT_QUEUE_LIST) && !!(STIMER_WAIT_DLIST_ENABLE)
+struct stimer_task_align_type
+{
+    uint8_t pad;
+    stimer_task_t task;
+};
+#define STIMER_TASK_ALIGN offsetof(struct stimer_task_align_type, task)
+/**
+ * @brief Extra bytes per task used by the doubly linked wait list
+ * @note prev_id plus the tail padding it adds, 0 if the option is disabled
+ */
+#define STIMER_WAIT_DLIST_COST (sizeof(stimer_task_t) - \
+    (offsetof(stimer_task_t, prev_id) + STIMER_TASK_ALIGN - 1) / STIMER_TASK_ALIGN * STIMER_TASK_ALIGN)
+#else
+#define STIMER_WAIT_DLIST_COST (0)
+#endif
+
 /**
  * @brief Get current task id
  * @retval uint16_t task id
  * @note Using in callback tasks
  */
-#define STIMER_SELF_ID hstimer.wait_id
+#define STIMER_SELF_ID ((uint16_t)(hstimer.ptask - hstimer.ptasks))
 /**
  * @brief Get current task handle
  * @retval stimer_task_t* timer task handle
  * @note Using in callback tasks
  */
-#define STIMER_SELF_TASK (&hstimer.ptasks[hstimer.wait_id])
+#define STIMER_SELF_TASK (hstimer.ptask)
 /**
  * @brief convert ticks to ms
  */
@@ -157,6 +251,14 @@ struct stimer_task_structure_type
  * @brief convert ms to ticks
  */
 #define STIMER_MS_TO_TICK(ms)    (ms*STIMER_TICK_PER_MS)
+/**
+ * @brief Signed distance from tick b to tick a, valid across counter wrap
+ */
+#define STIMER_TIME_DIFF(a, b)   ((stimer_stime_t)((stimer_time_t)(a) - (stimer_time_t)(b)))
+/**
+ * @brief Tick a is earlier than tick b
+ */
+#define STIMER_TIME_BEFORE(a, b) (STIMER_TIME_DIFF(a, b) < 0)
 
 extern stimer_t hstimer;
 /*-----------------------------------------------------------------------
@@ -176,7 +278,10 @@ stimer_time_t stimer_get_tick(void);
 uint16_t stiemr_get_waitCnt(void);
 uint16_t stimer_get_waitID(void);
 stimer_time_t stimer_get_nextExpire(void);
+#if !(STIMER_TIME_64BIT_ENABLE)
 uint16_t stimer_get_resetCnt(void);
+#endif
+uint16_t stimer_get_free_cnt(void);
 stimer_task_t *stimer_find_waitTask(uint16_t id);
 uint16_t stimer_get_wait_table(uint16_t* task_table, stimer_time_t* time_table, uint16_t size);
 
@@ -200,6 +305,10 @@ void stimer_task_set_callback(uint16_t id, stimer_pfunc_t task_callback);
 #define stimer_set_assert_callback(NO_EFFECT)
 #endif
 
+#if !!(STIMER_ONESHOT_INDEX_ENABLE)
+void stimer_set_oneshot_index(uint16_t *index, uint16_t size);
+#endif
+
 #if !!(STIMER_TASK_ARG_ENABLE)
 void *stimer_task_get_arg(uint16_t id);
 void stimer_task_set_arg(uint16_t id, void *arg);
@@ -19,6 +19,7 @@ int test_count = 0, test_pass = 0, main_ret = 0;
     } while(0)
 
 #define EXPECT_EQ_INT(expect, actual) EXPECT_EQ_BASE((expect) == (actual), expect, actual, "%d")
+#define EXPECT_EQ_TIME(expect, actual) EXPECT_EQ_BASE((stimer_time_t)(expect) == (stimer_time_t)(actual), (unsigned long long)(expect), (unsigned long long)(actual), "%llu")
 #define EXPECT_EQ_PTR(expect, actual) EXPECT_EQ_BASE(((void*)expect) == (void*)(actual), (void*)expect, (void*)actual, "%p")
 
 /* End unit test define */
@@ -43,7 +44,7 @@ uint16_t repeat_table[] = {
 #define task_function_template(NAME) \
     void NAME(void const *arg){\
         static int cnt = 0;\
-        printf("[%d]taskName:[" #NAME "] arg:[%p] cnt:[%d]\n", stimer_get_tick(), arg, ++cnt);\
+        printf("[%llu]taskName:[" #NAME "] arg:[%p] cnt:[%d]\n", (unsigned long long)stimer_get_tick(), arg, ++cnt);\
     }
 
 task_function_template(task0)
@@ -60,8 +61,11 @@ stimer_pfunc_t task_func_table[] = {
 
 
 stimer_task_t task_buffer[TASK_SIZE];
+#if !!(STIMER_ONESHOT_INDEX_ENABLE)
+uint16_t task_index[8];
+#endif
 uint16_t task_table[TASK_SIZE];
-uint32_t time_table[TASK_SIZE];
+stimer_time_t time_table[TASK_SIZE];
 
 
 /* Start test value define */
@@ -80,7 +84,7 @@ static void test_task_create(stimer_pfunc_t *taskTable, uint16_t *intervalTable,
     for (size_t i = 0; i < TASK_SIZE; i++)
     {
         EXPECT_EQ_PTR(taskTable[i], stimer_task_get_callback(i));
-        EXPECT_EQ_INT(intervalTable[i], stimer_task_get_interval(i));
+        EXPECT_EQ_TIME(intervalTable[i], stimer_task_get_interval(i));
         EXPECT_EQ_INT(priorityTable[i], stimer_task_get_priority(i));
         EXPECT_EQ_INT(repeatTable[i], stimer_task_get_repetitions(i));
     }
@@ -98,7 +102,7 @@ static void test_task_scheduler(uint32_t startTime, uint32_t endTime, const uint
     for (size_t i = 0; i < tableSize; i++)
     {
         EXPECT_EQ_INT(expect_idTable[i], run_task_result[i]);
-        EXPECT_EQ_INT(expect_timeTable[i], run_task_time[i]);
+        EXPECT_EQ_TIME(expect_timeTable[i], run_task_time[i]);
     }
     
 }
@@ -205,10 +209,7 @@ static void test_task_tick_overflow(stimer_pfunc_t *taskFuncTable, uint16_t tabl
             time : [max-1]  max  0  1  2  ...
             task0:    0      -   0  -  -
             task1:    -      -   1  -  -
-            convert to:
-            time : 0  1  2  3...
-            task0: 0  -  0  -
-            task1: -  -  1  -
+            the tick counter wraps without rebasing the waiting tasks
     */
     id0 = stimer_create_task(taskFuncTable[0], 1, 1, 0);
     stimer_task_start(id0, 2, NULL);
@@ -226,6 +227,61 @@ static void test_task_tick_overflow(stimer_pfunc_t *taskFuncTable, uint16_t tabl
     EXPECT_EQ_INT(id1, run_task_result[2]);
 }
 
+static void test_task_long_interval(stimer_pfunc_t *taskFuncTable, uint16_t tableSize)
+{
+    assert(tableSize >= 5);
+    /* intervals across every wheel level and beyond the wheel range */
+    const stimer_time_t interval[] = {1, 70, 5000, 300000, 20000000};
+    uint16_t id[5];
+    stimer_set_waitCnt(0);
+    stimer_set_tick(0);
+    run_task_cnt = 0;
+
+    for (size_t i = 0; i < 5; i++)
+    {
+        id[i] = stimer_create_task(taskFuncTable[i], interval[i], 1, 0);
+        stimer_task_start(id[i], 2, NULL);
+    }
+    EXPECT_EQ_INT(id[0], stimer_get_waitID());
+    while (stiemr_get_waitCnt())
+    {
+        stimer_set_tick(stimer_get_nextExpire());
+        stimer_serve();
+    }
+    EXPECT_EQ_INT(10, run_task_cnt);
+    for (size_t i = 0; i < 5; i++)
+    {
+        EXPECT_EQ_INT(id[i], run_task_result[i * 2]);
+        EXPECT_EQ_TIME(interval[i], run_task_time[i * 2]);
+        EXPECT_EQ_INT(id[i], run_task_result[i * 2 + 1]);
+        EXPECT_EQ_TIME(interval[i] * 2, run_task_time[i * 2 + 1]);
+    }
+}
+
+static void test_task_free_cnt(stimer_pfunc_t *taskFuncTable, uint16_t tableSize)
+{
+    assert(tableSize >= 1);
+    uint16_t id0, id1, free_cnt;
+    stimer_set_waitCnt(0);
+    stimer_set_tick(0);
+    run_task_cnt = 0;
+
+    free_cnt = stimer_get_free_cnt();
+    id0 = stimer_create_task(taskFuncTable[0], 1, 1, 0);
+    EXPECT_EQ_INT(free_cnt - 1, stimer_get_free_cnt());
+    stimer_task_start(id0, 1, NULL);
+    stimer_set_tick(stimer_get_nextExpire());
+    stimer_serve();
+    EXPECT_EQ_INT(1, run_task_cnt);
+    EXPECT_EQ_INT(free_cnt, stimer_get_free_cnt());
+    // the released slot is reused first
+    id1 = stimer_task_oneshot(taskFuncTable[0], 1, 1, NULL);
+    EXPECT_EQ_INT(id0, id1);
+    EXPECT_EQ_INT(free_cnt - 1, stimer_get_free_cnt());
+    stimer_task_stop(id1);
+    EXPECT_EQ_INT(free_cnt, stimer_get_free_cnt());
+}
+
 static void test_task_preserve(stimer_pfunc_t *taskFuncTable, uint16_t tableSize)
 {
     assert(tableSize >= 1);
@@ -261,6 +317,77 @@ static void test_task_repete(stimer_pfunc_t *taskFuncTable, uint16_t tableSize)
     EXPECT_EQ_INT(tableSize, run_task_cnt);
 }
 
+#define WRAP_TASK_SIZE  32
+#define WRAP_ROUNDS     2000
+#define WRAP_REPEAT     4
+stimer_time_t wrap_last_tick;
+stimer_time_t wrap_expect_tick[WRAP_TASK_SIZE];
+uint32_t wrap_run_cnt, wrap_error_cnt;
+
+static void wrap_task(void const *arg)
+{
+    (void)arg;
+}
+
+static void wrap_task_start_hook(uint16_t id)
+{
+    stimer_time_t tick = stimer_get_tick();
+    // every task runs exactly on time and dispatch never goes back across the wrap
+    if (tick != wrap_expect_tick[id] || STIMER_TIME_BEFORE(tick, wrap_last_tick))
+    {
+        wrap_error_cnt++;
+    }
+    wrap_expect_tick[id] = tick + stimer_task_get_interval(id);
+    wrap_last_tick = tick;
+    wrap_run_cnt++;
+}
+
+static void test_task_tick_wrap(void)
+{
+    stimer_task_t wrap_buffer[WRAP_TASK_SIZE];
+    stimer_time_t base;
+    uint16_t id;
+#if !(STIMER_TIME_64BIT_ENABLE)
+    uint16_t reset_cnt;
+    uint32_t wrap_cnt = 0;
+#endif
+
+    stimer_init(wrap_buffer, WRAP_TASK_SIZE);
+    stimer_set_task_start_hook(wrap_task_start_hook);
+    wrap_run_cnt = 0;
+    wrap_error_cnt = 0;
+    for (uint32_t round = 0; round < WRAP_ROUNDS; round++)
+    {
+        /* start all tasks a few ticks before the counter wraps */
+        base = (stimer_time_t)(STIMER_MAX_TIMETICK - round % 64);
+        stimer_set_tick(base);
+        wrap_last_tick = base;
+#if !(STIMER_TIME_64BIT_ENABLE)
+        reset_cnt = stimer_get_resetCnt();
+#endif
+        for (size_t i = 0; i < WRAP_TASK_SIZE; i++)
+        {
+            id = stimer_create_task(wrap_task, i % 16 + 1, i % 4, 0);
+            stimer_task_start(id, WRAP_REPEAT, NULL);
+            wrap_expect_tick[id] = base + stimer_task_get_interval(id);
+        }
+        while (stiemr_get_waitCnt())
+        {
+            stimer_tick_increase();
+            stimer_serve();
+        }
+#if !(STIMER_TIME_64BIT_ENABLE)
+        wrap_cnt += (uint16_t)(stimer_get_resetCnt() - reset_cnt);
+#endif
+    }
+#if !(STIMER_TIME_64BIT_ENABLE)
+    EXPECT_EQ_INT(WRAP_ROUNDS, wrap_cnt);
+#endif
+    EXPECT_EQ_INT(WRAP_ROUNDS * WRAP_TASK_SIZE * WRAP_REPEAT, wrap_run_cnt);
+    EXPECT_EQ_INT(0, wrap_error_cnt);
+    EXPECT_EQ_INT(WRAP_TASK_SIZE, stimer_get_free_cnt());
+}
+
 int critical_counter = 0;
 void __disable_irq(void)
 {
@@ -277,7 +404,7 @@ void task_run_start_hook(uint16_t id)
     run_task_time[run_task_cnt] = stimer_get_tick();
     run_task_cnt++;
 #if 0
-    printf("task %d run at %d\n", id, stimer_get_tick());
+    printf("task %d run at %llu\n", id, (unsigned long long)stimer_get_tick());
 #endif
 }
 
@@ -309,6 +436,9 @@ int main(void)
     tick   1, 1, 2, 2, 2, 3, 3, 4, 4, 4, 5, 6, 6, 7, 8, 8
     */
     stimer_init(task_buffer, TASK_SIZE);
+#if !!(STIMER_ONESHOT_INDEX_ENABLE)
+    stimer_set_oneshot_index(task_index, sizeof(task_index) / sizeof(task_index[0]));
+#endif
     stimer_set_task_start_hook(task_run_start_hook);
     stimer_set_task_schedule_hook(task_run_schedule_hook);
 
@@ -343,14 +473,21 @@ int main(void)
     EXPECT_EQ_INT(0, critical_counter);
     test_task_tick_overflow(task_func_table, TASK_SIZE);
     EXPECT_EQ_INT(0, critical_counter);
+    test_task_long_interval(task_func_table, TASK_SIZE);
+    EXPECT_EQ_INT(0, critical_counter);
+    test_task_free_cnt(task_func_table, TASK_SIZE);
+    EXPECT_EQ_INT(0, critical_counter);
     test_task_preserve(task_func_table, TASK_SIZE);
     EXPECT_EQ_INT(0, critical_counter);
     test_task_repete(task_func_table, TASK_SIZE);
     EXPECT_EQ_INT(0, critical_counter);
+    test_task_tick_wrap();
+    EXPECT_EQ_INT(0, critical_counter);
 
     free(run_task_result);
     free(run_task_time);
 
     printf("all test done\n");
     printf("result: %d/%d (%3.2f%%) passed\n", test_pass, test_count, test_pass * 100.0 / test_count);
+    return main_ret;
 }